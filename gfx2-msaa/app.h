@@ -13,6 +13,11 @@ struct app_data
 		struct rjd_gfx_pipeline_state* pipeline_state;
 		struct rjd_gfx_mesh* mesh;
 	} gfx;
+	struct {
+		rjd_math_mat4 proj_matrix;
+		rjd_math_mat4 view_matrix;
+		struct rjd_window_size proj_size;
+	} camera;
 };
 
 void env_init(const struct rjd_window_environment* env);
@@ -348,6 +348,18 @@ void window_init(struct rjd_window* window, const struct rjd_window_environment*
 		}
 	}
 
+	// camera
+	{
+		const rjd_math_vec3 origin = rjd_math_vec3_xyz(0,0,0);
+		const rjd_math_vec3 right = rjd_math_vec3_xyz(1,0,0);
+
+		const rjd_math_vec3 pos = rjd_math_vec3_xyz(0, 0, 100);
+		const rjd_math_vec3 look = rjd_math_vec3_normalize(rjd_math_vec3_sub(origin, pos));
+		const rjd_math_vec3 up = rjd_math_vec3_normalize(rjd_math_vec3_cross(right, look));
+
+		app->camera.view_matrix = rjd_math_mat4_lookat_righthanded(pos, look, up);
+	}
+
 	{
 		struct rjd_result result = rjd_gfx_present(app->gfx.context);
 		if (!rjd_result_isok(result)) {
@@ -396,33 +408,25 @@ bool window_update(struct rjd_window* window, const struct rjd_window_environmen
 		
 		// update constant buffer transforms
 		{
+			// the camera never moves, so only the projection changes, and only when the window is resized
 			const struct rjd_window_size bounds = rjd_window_size_get(window);
-
-			rjd_math_vec3 pos, look, up;
-			{
-				const rjd_math_vec3 origin = rjd_math_vec3_xyz(0,0,0);
-				const rjd_math_vec3 right = rjd_math_vec3_xyz(1,0,0);
-
-				pos = rjd_math_vec3_xyz(0, 0, 100);
-				look = rjd_math_vec3_normalize(rjd_math_vec3_sub(origin, pos));
-				up = rjd_math_vec3_normalize(rjd_math_vec3_cross(right, look));
+			if (bounds.width != app->camera.proj_size.width || bounds.height != app->camera.proj_size.height) {
+				const float y_field_of_view = RJD_MATH_PI*2*60/360;
+				const float aspect = (float)bounds.width / bounds.height;
+				const float near = 0.1f;
+				const float far = 1000.0f;
+				app->camera.proj_matrix = rjd_math_mat4_perspective_righthanded(y_field_of_view, aspect, near, far);
+				app->camera.proj_size = bounds;
 			}
 
-			const float y_field_of_view = RJD_MATH_PI*2*60/360;
-			const float aspect = (float)bounds.width / bounds.height;
-			const float near = 0.1f;
-			const float far = 1000.0f;
-			rjd_math_mat4 proj_matrix = rjd_math_mat4_perspective_righthanded(y_field_of_view, aspect, near, far);
-			rjd_math_mat4 view_matrix = rjd_math_mat4_lookat_righthanded(pos, look, up);
 			rjd_math_mat4 model_matrix;
 			{
 				static float s_rotation_x = 0;
 				static float s_rotation_y = 5 * RJD_MATH_PI / 6.0f;
-				rjd_math_mat4 trans = rjd_math_mat4_translation(rjd_math_vec3_xyz(0, 0, 0));
+				// the object sits at the origin, so there's no translation to apply
 				rjd_math_mat4 rot1 = rjd_math_mat4_rotationx(s_rotation_x);
 				rjd_math_mat4 rot2 = rjd_math_mat4_rotationy(s_rotation_y);
 				model_matrix = rjd_math_mat4_mul(rot1, rot2);
-				model_matrix = rjd_math_mat4_mul(trans, model_matrix);
 
 				float speed = 8;
 				s_rotation_x += (RJD_MATH_PI * 2.0f / (60.0f * 1 * speed));
@@ -430,8 +434,8 @@ bool window_update(struct rjd_window* window, const struct rjd_window_environmen
 			}
 			
 			const struct shader_constants constants = {
-				.proj_matrix = proj_matrix,
-				.modelview_matrix = rjd_math_mat4_mul(view_matrix, model_matrix)
+				.proj_matrix = app->camera.proj_matrix,
+				.modelview_matrix = rjd_math_mat4_mul(app->camera.view_matrix, model_matrix)
 			};
 			
 			// Upload matrices to constant buffer
@@ -2,6 +2,12 @@
 
 #include "../rjd/rjd_all.h"
 
+enum
+{
+	SHAPE_LOD_COUNT = 3,
+	SHAPE_INSTANCE_COUNT = 4,
+};
+
 struct app_data
 {
 	struct rjd_mem_allocator* allocator;
@@ -16,6 +22,15 @@ struct app_data
 		struct rjd_gfx_pipeline_state* pipeline_state_cullnone;
 		struct rjd_gfx_mesh* meshes;
 	} gfx;
+	struct {
+		rjd_math_mat4 proj_matrix;
+		rjd_math_mat4 view_matrix;
+		struct rjd_window_size proj_size;
+		float distance;
+	} camera;
+	float shape_radius[RJD_PROCGEO_TYPE_COUNT];
+	uint32_t instance_lods[SHAPE_INSTANCE_COUNT];
+	uint32_t reported_verts_drawn;
 	uint32_t current_mesh_index;
 };
 
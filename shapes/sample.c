@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include <math.h>
 #include "app.h"
 
 struct shader_constants
@@ -8,11 +9,87 @@ struct shader_constants
 	rjd_math_mat4 modelview_matrix;
 };
 
+static const float k_shape_size = .5;
+static const float k_camera_y_field_of_view = RJD_MATH_PI*2*60/360;
+
+// Each up/down arrow press divides/multiplies the camera distance by k_camera_zoom_step, clamped to
+// [k_camera_min_distance, k_camera_max_distance]
+static const float k_camera_start_distance = 2;
+static const float k_camera_min_distance = 1;
+static const float k_camera_max_distance = 64;
+static const float k_camera_zoom_step = 1.25f;
+
+// The same shape is drawn several times at increasing depths so each instance ends up at a different lod
+static const float k_instance_positions[SHAPE_INSTANCE_COUNT][3] = {
+	{  0, 0,   0 },
+	{  1, 0,  -6 },
+	{ -2, 0, -14 },
+	{  4, 0, -30 },
+};
+
+// Each shape is generated at every tesselation level, finest first. A lod is used once the shape is
+// at least k_lod_min_pixels tall on screen. Going back to a coarser lod requires the shape to shrink
+// a further k_lod_hysteresis below that size, so a shape sitting near a threshold doesn't flicker.
+static const uint32_t k_lod_tesselations[SHAPE_LOD_COUNT] = { 16, 8, 4 };
+static const float k_lod_min_pixels[SHAPE_LOD_COUNT] = { 128, 32, 0 };
+static const float k_lod_hysteresis = 0.8f;
+
 uint32_t calc_shader_constants_stride()
 {
 	return rjd_gfx_calc_constant_buffer_stride(sizeof(struct shader_constants));
 }
 
+uint32_t select_lod(uint32_t current_lod, float screen_pixels)
+{
+	uint32_t lod = current_lod;
+	while (lod > 0 && screen_pixels >= k_lod_min_pixels[lod - 1]) {
+		--lod;
+	}
+	while (lod + 1 < SHAPE_LOD_COUNT && screen_pixels < k_lod_min_pixels[lod] * k_lod_hysteresis) {
+		++lod;
+	}
+	return lod;
+}
+
+struct rjd_gfx_mesh* get_shape_mesh(struct app_data* app, uint32_t lod)
+{
+	return app->gfx.meshes + app->current_mesh_index * SHAPE_LOD_COUNT + lod;
+}
+
+void update_view_matrix(struct app_data* app)
+{
+	const rjd_math_vec3 origin = rjd_math_vec3_xyz(0,0,0);
+	const rjd_math_vec3 right = rjd_math_vec3_xyz(1,0,0);
+
+	const rjd_math_vec3 pos = rjd_math_vec3_xyz(0, 0, app->camera.distance);
+	const rjd_math_vec3 look = rjd_math_vec3_normalize(rjd_math_vec3_sub(origin, pos));
+	const rjd_math_vec3 up = rjd_math_vec3_normalize(rjd_math_vec3_cross(right, look));
+
+	app->camera.view_matrix = rjd_math_mat4_lookat_righthanded(pos, look, up);
+}
+
+// Projects a bounding sphere through the same view and projection matrices the shapes are drawn with,
+// so the size matches what ends up on screen regardless of the matrix conventions.
+float calc_screen_pixels(const struct app_data* app, const float position[3], float radius, uint32_t window_height)
+{
+	const rjd_math_vec4 view_center = rjd_math_mat4_mulv4(app->camera.view_matrix, rjd_math_vec4_xyzw(position[0], position[1], position[2], 1));
+	const rjd_math_vec4 view_top = rjd_math_vec4_add(view_center, rjd_math_vec4_xyzw(0, radius, 0, 0));
+
+	float clip_center[4];
+	float clip_top[4];
+	rjd_math_vec4_write(rjd_math_mat4_mulv4(app->camera.proj_matrix, view_center), clip_center);
+	rjd_math_vec4_write(rjd_math_mat4_mulv4(app->camera.proj_matrix, view_top), clip_top);
+
+	// behind the camera
+	if (clip_center[3] <= 0) {
+		return 0;
+	}
+
+	// ndc y spans 2 units over the window height and the diameter is 2 radii, so the factors cancel
+	const float ndc_radius = fabsf(clip_top[1] / clip_top[3] - clip_center[1] / clip_center[3]);
+	return ndc_radius * window_height;
+}
+
 void env_init(const struct rjd_window_environment* env)
 {
 	struct app_data* app = env->userdata;
@@ -69,7 +146,7 @@ void window_init(struct rjd_window* window, const struct rjd_window_environment*
 	app->gfx.shader_pixel = rjd_mem_alloc(struct rjd_gfx_shader, app->allocator);
 	app->gfx.pipeline_state_cullback = rjd_mem_alloc(struct rjd_gfx_pipeline_state, app->allocator);
 	app->gfx.pipeline_state_cullnone = rjd_mem_alloc(struct rjd_gfx_pipeline_state, app->allocator);
-	app->gfx.meshes = rjd_mem_alloc_array(struct rjd_gfx_mesh, RJD_PROCGEO_TYPE_COUNT, app->allocator);
+	app->gfx.meshes = rjd_mem_alloc_array(struct rjd_gfx_mesh, RJD_PROCGEO_TYPE_COUNT * SHAPE_LOD_COUNT, app->allocator);
 
 	{
 		struct rjd_gfx_context_desc desc = {
@@ -221,14 +298,25 @@ void window_init(struct rjd_window* window, const struct rjd_window_environment*
 		}
 
 		// meshes
-		for (enum rjd_procgeo_type geo = 0; geo < RJD_PROCGEO_TYPE_COUNT; ++geo)
+		for (uint32_t mesh_index = 0; mesh_index < RJD_PROCGEO_TYPE_COUNT * SHAPE_LOD_COUNT; ++mesh_index)
 		{
-			const float shape_size = .5;
-			const uint32_t tesselation = 16;
+			const enum rjd_procgeo_type geo = mesh_index / SHAPE_LOD_COUNT;
+			const uint32_t tesselation = k_lod_tesselations[mesh_index % SHAPE_LOD_COUNT];
  
 			const uint32_t num_verts = rjd_procgeo_calc_num_verts(geo, tesselation);
 			float* positions = rjd_mem_alloc_array(float, num_verts * 3, app->allocator);
-			rjd_procgeo(geo, tesselation, shape_size, shape_size, shape_size, positions, num_verts * 3, 0);
+			rjd_procgeo(geo, tesselation, k_shape_size, k_shape_size, k_shape_size, positions, num_verts * 3, 0);
+
+			// Measure the bounding radius from the generated vertices instead of assuming how rjd_procgeo
+			// interprets the size. The finest lod is used since the coarser ones fit inside it.
+			if (mesh_index % SHAPE_LOD_COUNT == 0) {
+				float radius_sq = 0;
+				for (uint32_t i = 0; i < num_verts * 3; i += 3) {
+					const float length_sq = positions[i] * positions[i] + positions[i + 1] * positions[i + 1] + positions[i + 2] * positions[i + 2];
+					radius_sq = length_sq > radius_sq ? length_sq : radius_sq;
+				}
+				app->shape_radius[geo] = sqrtf(radius_sq);
+			}
 
 			const rjd_math_vec4 k_red = rjd_math_vec4_xyzw(1,0,0,1);
 			const rjd_math_vec4 k_green = rjd_math_vec4_xyzw(0,1,0,1);
@@ -273,7 +361,7 @@ void window_init(struct rjd_window* window, const struct rjd_window_environment*
 				{
 					.common = {
 						.constant = {
-							.capacity = calc_shader_constants_stride() * 3,
+							.capacity = calc_shader_constants_stride() * 3 * SHAPE_INSTANCE_COUNT,
 						}
 					},
 					.usage_flags = RJD_GFX_MESH_BUFFER_USAGE_VERTEX_CONSTANT | RJD_GFX_MESH_BUFFER_USAGE_PIXEL_CONSTANT,
@@ -290,7 +378,7 @@ void window_init(struct rjd_window* window, const struct rjd_window_environment*
 				.count_vertices = num_verts,
 			};
 
-			struct rjd_result result = rjd_gfx_mesh_create_vertexed(app->gfx.context, app->gfx.meshes + geo, desc);
+			struct rjd_result result = rjd_gfx_mesh_create_vertexed(app->gfx.context, app->gfx.meshes + mesh_index, desc);
 			if (!rjd_result_isok(result)) {
 				RJD_LOG("Error creating mesh: %s", result.error);
 			}
@@ -300,6 +388,10 @@ void window_init(struct rjd_window* window, const struct rjd_window_environment*
 		}
 	}
 
+	// camera
+	app->camera.distance = k_camera_start_distance;
+	update_view_matrix(app);
+
 	{
 		struct rjd_result result = rjd_gfx_present(app->gfx.context);
 		if (!rjd_result_isok(result)) {
@@ -329,6 +421,25 @@ bool window_update(struct rjd_window* window, const struct rjd_window_environmen
 		app->current_mesh_index = (app->current_mesh_index + 1) % RJD_PROCGEO_TYPE_COUNT;
 	}
 
+	// the view matrix is only rebuilt when the camera actually moves
+	{
+		float distance = app->camera.distance;
+		if (rjd_input_keyboard_triggered(app->input, RJD_INPUT_KEYBOARD_ARROW_UP)) {
+			distance /= k_camera_zoom_step;
+			distance = distance < k_camera_min_distance ? k_camera_min_distance : distance;
+		}
+
+		if (rjd_input_keyboard_triggered(app->input, RJD_INPUT_KEYBOARD_ARROW_DOWN)) {
+			distance *= k_camera_zoom_step;
+			distance = distance > k_camera_max_distance ? k_camera_max_distance : distance;
+		}
+
+		if (distance != app->camera.distance) {
+			app->camera.distance = distance;
+			update_view_matrix(app);
+		}
+	}
+
 	rjd_input_markframe(app->input);
 
 	struct rjd_gfx_command_buffer command_buffer = {0};
@@ -354,67 +465,35 @@ bool window_update(struct rjd_window* window, const struct rjd_window_environmen
 		}
 	}
 
-	// draw a quad
+	// draw the shapes
 	{
-		struct rjd_gfx_pass_draw_buffer_offset_desc buffer_offset_descs[1] = {0};
-		
-		// update constant buffer transforms
-		{
-			const struct rjd_window_size bounds = rjd_window_size_get(window);
-
-			rjd_math_vec3 pos, look, up;
-			{
-				const rjd_math_vec3 origin = rjd_math_vec3_xyz(0,0,0);
-				const rjd_math_vec3 right = rjd_math_vec3_xyz(1,0,0);
-
-				pos = rjd_math_vec3_xyz(0, 0, 100);
-				look = rjd_math_vec3_normalize(rjd_math_vec3_sub(origin, pos));
-				up = rjd_math_vec3_normalize(rjd_math_vec3_cross(right, look));
-			}
+		const struct rjd_window_size bounds = rjd_window_size_get(window);
 
-			const float y_field_of_view = RJD_MATH_PI*2*60/360;
+		// the projection only changes when the window is resized
+		if (bounds.width != app->camera.proj_size.width || bounds.height != app->camera.proj_size.height) {
 			const float aspect = (float)bounds.width / bounds.height;
 			const float near = 0.1f;
 			const float far = 1000.0f;
-			rjd_math_mat4 proj_matrix = rjd_math_mat4_perspective_righthanded(y_field_of_view, aspect, near, far);
-			rjd_math_mat4 view_matrix = rjd_math_mat4_lookat_righthanded(pos, look, up);
-			rjd_math_mat4 model_matrix;
-			{
-				static float s_rotation_x = 0;
-				static float s_rotation_y = 5 * RJD_MATH_PI / 6.0f;
-				rjd_math_mat4 trans = rjd_math_mat4_translation(rjd_math_vec3_xyz(0, 0, 0));
-				rjd_math_mat4 rot1 = rjd_math_mat4_rotationx(s_rotation_x);
-				rjd_math_mat4 rot2 = rjd_math_mat4_rotationy(s_rotation_y);
-				model_matrix = rjd_math_mat4_mul(rot1, rot2);
-				model_matrix = rjd_math_mat4_mul(trans, model_matrix);
-
-				float speed = 8;
-				s_rotation_x += (RJD_MATH_PI * 2.0f / (60.0f * 1 * speed));
-				s_rotation_y += (RJD_MATH_PI * 2.0f / (60.0f * 2 * speed));
-			}
-			
-			const struct shader_constants constants = {
-				.proj_matrix = proj_matrix,
-				.modelview_matrix = rjd_math_mat4_mul(view_matrix, model_matrix)
-			};
-			
-			// Upload matrices to constant buffer
-			const uint32_t buffer_index = 2;
-			const uint32_t stride = calc_shader_constants_stride();
-			const uint32_t offset = rjd_gfx_backbuffer_current_index(app->gfx.context) * stride;
-
-			rjd_gfx_mesh_modify(app->gfx.context, &command_buffer, app->gfx.meshes + app->current_mesh_index, buffer_index, offset, &constants, sizeof(constants));
+			app->camera.proj_matrix = rjd_math_mat4_perspective_righthanded(k_camera_y_field_of_view, aspect, near, far);
+			app->camera.proj_size = bounds;
+		}
 
-			buffer_offset_descs[0].mesh_index = 0;
-			buffer_offset_descs[0].buffer_index = buffer_index;
-			buffer_offset_descs[0].offset_bytes = offset;
-			buffer_offset_descs[0].range_bytes = stride;
+		rjd_math_mat4 rotation_matrix;
+		{
+			static float s_rotation_x = 0;
+			static float s_rotation_y = 5 * RJD_MATH_PI / 6.0f;
+			rjd_math_mat4 rot1 = rjd_math_mat4_rotationx(s_rotation_x);
+			rjd_math_mat4 rot2 = rjd_math_mat4_rotationy(s_rotation_y);
+			rotation_matrix = rjd_math_mat4_mul(rot1, rot2);
+
+			float speed = 8;
+			s_rotation_x += (RJD_MATH_PI * 2.0f / (60.0f * 1 * speed));
+			s_rotation_y += (RJD_MATH_PI * 2.0f / (60.0f * 2 * speed));
 		}
 
-		const struct rjd_window_size window_size = rjd_window_size_get(app->window);
 		const struct rjd_gfx_viewport viewport = {
-			.width = window_size.width,
-			.height = window_size.height
+			.width = bounds.width,
+			.height = bounds.height
 		};
 		const uint32_t texture_indices[] = {0};
 
@@ -424,20 +503,69 @@ bool window_update(struct rjd_window* window, const struct rjd_window_environmen
 			pipeline_state = app->gfx.pipeline_state_cullnone;
 		}
 
-		struct rjd_gfx_pass_draw_desc desc = {
-			.viewport = &viewport,
-			.pipeline_state = pipeline_state,
-			.meshes = app->gfx.meshes + app->current_mesh_index,
-			.buffer_offset_descs = buffer_offset_descs,
-			.textures = app->gfx.texture,
-			.texture_indices = texture_indices,
-			.count_meshes = 1,
-			.count_constant_descs = 1,
-			.count_textures = 0,
-			.debug_label = "a shape",
-		};
+		const enum rjd_procgeo_type geo = app->current_mesh_index;
+		uint32_t verts_drawn = 0;
+		uint32_t verts_lod0 = 0;
+
+		for (uint32_t i = 0; i < SHAPE_INSTANCE_COUNT; ++i) {
+			const float* position = k_instance_positions[i];
+
+			const float screen_pixels = calc_screen_pixels(app, position, app->shape_radius[geo], bounds.height);
+			const uint32_t lod = select_lod(app->instance_lods[i], screen_pixels);
+			app->instance_lods[i] = lod;
+
+			verts_drawn += rjd_procgeo_calc_num_verts(geo, k_lod_tesselations[lod]);
+			verts_lod0 += rjd_procgeo_calc_num_verts(geo, k_lod_tesselations[0]);
 
-		rjd_gfx_command_pass_draw(app->gfx.context, &command_buffer, &desc);
+			struct rjd_gfx_mesh* mesh = get_shape_mesh(app, lod);
+
+			const rjd_math_mat4 trans = rjd_math_mat4_translation(rjd_math_vec3_xyz(position[0], position[1], position[2]));
+			const rjd_math_mat4 model_matrix = rjd_math_mat4_mul(trans, rotation_matrix);
+
+			const struct shader_constants constants = {
+				.proj_matrix = app->camera.proj_matrix,
+				.modelview_matrix = rjd_math_mat4_mul(app->camera.view_matrix, model_matrix)
+			};
+
+			// Upload matrices to constant buffer. Each instance gets its own slot per backbuffer since
+			// several instances can share the same lod mesh.
+			const uint32_t buffer_index = 2;
+			const uint32_t stride = calc_shader_constants_stride();
+			const uint32_t offset = (rjd_gfx_backbuffer_current_index(app->gfx.context) * SHAPE_INSTANCE_COUNT + i) * stride;
+
+			rjd_gfx_mesh_modify(app->gfx.context, &command_buffer, mesh, buffer_index, offset, &constants, sizeof(constants));
+
+			struct rjd_gfx_pass_draw_buffer_offset_desc buffer_offset_descs[1] = {0};
+			buffer_offset_descs[0].mesh_index = 0;
+			buffer_offset_descs[0].buffer_index = buffer_index;
+			buffer_offset_descs[0].offset_bytes = offset;
+			buffer_offset_descs[0].range_bytes = stride;
+
+			struct rjd_gfx_pass_draw_desc desc = {
+				.viewport = &viewport,
+				.pipeline_state = pipeline_state,
+				.meshes = mesh,
+				.buffer_offset_descs = buffer_offset_descs,
+				.textures = app->gfx.texture,
+				.texture_indices = texture_indices,
+				.count_meshes = 1,
+				.count_constant_descs = 1,
+				.count_textures = 0,
+				.debug_label = "a shape",
+			};
+
+			rjd_gfx_command_pass_draw(app->gfx.context, &command_buffer, &desc);
+		}
+
+		if (verts_drawn != app->reported_verts_drawn) {
+			RJD_LOG("camera at %.2f: drawing %u verts across %d shapes, %u at lod 0 (%.0f%%)",
+				app->camera.distance,
+				verts_drawn,
+				SHAPE_INSTANCE_COUNT,
+				verts_lod0,
+				100.0f * verts_drawn / verts_lod0);
+			app->reported_verts_drawn = verts_drawn;
+		}
 	}
 
 	rjd_gfx_command_buffer_commit(app->gfx.context, &command_buffer);
@@ -456,7 +584,7 @@ void window_close(struct rjd_window* window, const struct rjd_window_environment
 	rjd_input_destroy(app->input);
 	rjd_mem_free(app->input);
 
-	for (uint32_t i = 0; i < RJD_PROCGEO_TYPE_COUNT; ++i) {
+	for (uint32_t i = 0; i < RJD_PROCGEO_TYPE_COUNT * SHAPE_LOD_COUNT; ++i) {
 		if (rjd_slot_isvalid(app->gfx.meshes[i].handle)) {
 			rjd_gfx_mesh_destroy(app->gfx.context, app->gfx.meshes + i);
 		}